@@ -1,14 +1,30 @@
 // multithread-safe progress bar.
+// main2.cpp compares parallel_for with thread-per-task, 10 threads and 20 jobs each, stderr redirected.
+// GCC 12.2 -O3 output, lock-free version. Only measured on a single-core machine, where the 10 workers
+// still steal from each other but no parallel speedup can show; numbers on more cores are still wanted.
+/* Fine-grained thread-per-task, per-item update : 2.09691s
+   Fine-grained thread-per-task, per-chunk update : 0.0607389s
+   Fine-grained parallel_for : 0.0571816s
+   Coarse-grained thread-per-task, per-item update : 0.946229s
+   Coarse-grained thread-per-task, per-chunk update : 0.955311s
+   Coarse-grained parallel_for : 0.93404s
+*/
+// Nearly all of the fine-grained gap comes from per-item update; reusing threads saves only a few percent here.
 #include <iostream>
 #include <mutex>
 #include <atomic>
 #include <format>
 #include <algorithm>
 #include <chrono>
+#include <thread>
+#include <vector>
+#include <deque>
+#include <functional>
+#include <condition_variable>
 
 // for test purpose
-#include <thread>
 #include <random>
+#include <cmath>
 
 // Lock-needed version.
 class ProgressBar
@@ -19,11 +35,12 @@ public:
     ProgressBar(int init_maxProgress) :counter{ 0 }, maxProgress(init_maxProgress), 
         barStr_(barLen_, ' '), lastPos_(0) {}
 
-    void update()
+    // step > 1 lets callers report a whole chunk of work at once.
+    void update(int step = 1)
     {
-        int currCnt = counter.fetch_add(1, std::memory_order_relaxed) + 1;
+        int prevCnt = counter.fetch_add(step, std::memory_order_relaxed), currCnt = prevCnt + step;
         std::unique_lock<std::mutex> _(guard_, std::try_to_lock);
-        bool ownLock = _.owns_lock(), ending = (currCnt == maxProgress);
+        bool ownLock = _.owns_lock(), ending = (prevCnt < maxProgress && currCnt >= maxProgress);
         auto endingOutput = [this]() {
             std::fill(barStr_.begin() + lastPos_, barStr_.end(), '#');
             std::cerr << std::format("[{0}] 100%\n", barStr_);
@@ -38,7 +55,8 @@ public:
                 return;
             }
             float percent = static_cast<float>(currCnt) / maxProgress;
-            int newPos = static_cast<int>(percent * barLen_);
+            // A thread holding a stale count may get the output after a newer one.
+            int newPos = std::clamp(static_cast<int>(percent * barLen_), lastPos_, barLen_);
             std::fill(barStr_.begin() + lastPos_, barStr_.begin() + newPos, '#');
             lastPos_ = newPos;
             std::cerr << std::format("[{0}] {1}%\r", barStr_, static_cast<int>(percent * 100.0f));
@@ -65,7 +83,7 @@ private:
     std::mutex guard_;
     std::string barStr_;
     int lastPos_;
-    static const int barLen_ = 50;
+    static constexpr int barLen_ = 50;
 };
 
 // Lock-free version
@@ -81,10 +99,11 @@ public:
     ProgressBar(int init_maxProgress) :counter{ 0 }, guard_{ true }, maxProgress(init_maxProgress),
         barStr_(barLen_, ' '), lastPos_(0) {}
 
-    void update()
+    // step > 1 lets callers report a whole chunk of work at once.
+    void update(int step = 1)
     {
-        int currCnt = counter.fetch_add(1, std::memory_order_relaxed) + 1;
-        bool ending = (currCnt == maxProgress);
+        int prevCnt = counter.fetch_add(step, std::memory_order_relaxed), currCnt = prevCnt + step;
+        bool ending = (prevCnt < maxProgress && currCnt >= maxProgress);
         auto endingOutput = [this]() {
             std::fill(barStr_.begin() + lastPos_, barStr_.end(), '#');
             std::cerr << std::format("[{0}] 100%\n", barStr_);
@@ -99,7 +118,8 @@ public:
                 return;
             }
             float percent = static_cast<float>(currCnt) / maxProgress;
-            int newPos = static_cast<int>(percent * barLen_);
+            // A thread holding a stale count may get the output after a newer one.
+            int newPos = std::clamp(static_cast<int>(percent * barLen_), lastPos_, barLen_);
             std::fill(barStr_.begin() + lastPos_, barStr_.begin() + newPos, '#');
             lastPos_ = newPos;
             std::cerr << std::format("[{0}] {1}%\r", barStr_, static_cast<int>(percent * 100.0f));
@@ -129,9 +149,161 @@ private:
     std::atomic<bool> guard_;
     std::string barStr_;
     int lastPos_;
-    static const int barLen_ = 50;
+    static constexpr int barLen_ = 50;
 };
 
+// Thread pool for parallel_for, workers are created once and reused by every job.
+// Each job is cut into chunks of `grain` items, which are dealt round-robin to per-worker
+// queues; a worker pops from the back of its own queue and steals from the front of others.
+// Progress is reported once per finished chunk, so the bar costs O(chunks) instead of O(items).
+// f must not throw, and must not call parallel_for on the same pool (it would deadlock).
+struct Range
+{
+    int begin;
+    int end;
+};
+
+class ThreadPool
+{
+public:
+    ThreadPool(unsigned int threadNum = std::thread::hardware_concurrency()) :
+        queues_(std::max(threadNum, 1u))
+    {
+        for (unsigned int i = 0; i < queues_.size(); i++)
+        {
+            workers_.emplace_back([this, i]() { workerLoop_(i); });
+        }
+    }
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> _(jobGuard_);
+            stop_ = true;
+        }
+        jobReady_.notify_all();
+        for (auto& worker : workers_)
+        {
+            worker.join();
+        }
+    }
+
+    template<typename Func>
+    void parallel_for(Range range, int grain, Func&& f, ProgressBar& bar)
+    {
+        if (range.end <= range.begin)
+            return;
+        grain = std::clamp(grain, 1, range.end - range.begin);
+
+        std::lock_guard<std::mutex> submit(submitGuard_);
+        chunkFunc_ = [&f, &bar](int begin, int end) {
+            for (int i = begin; i < end; i++)
+            {
+                f(i);
+            }
+            bar.update(end - begin);
+        };
+
+        int chunkNum = (range.end - range.begin - 1) / grain + 1;
+        remainingChunks_.store(chunkNum, std::memory_order_relaxed);
+        for (int i = 0; i < chunkNum; i++)
+        {
+            int begin = range.begin + i * grain;
+            auto& queue = queues_[i % queues_.size()];
+            std::lock_guard<std::mutex> _(queue.guard);
+            queue.chunks.emplace_back(begin, begin + std::min(grain, range.end - begin));
+        }
+
+        std::unique_lock<std::mutex> lock(jobGuard_);
+        ++jobId_;
+        jobReady_.notify_all();
+        jobDone_.wait(lock, [this]() { return remainingChunks_.load(std::memory_order_acquire) == 0; });
+        return;
+    }
+
+private:
+    struct alignas(64) WorkQueue
+    {
+        std::mutex guard;
+        std::deque<std::pair<int, int>> chunks;
+    };
+
+    bool popOrSteal_(unsigned int id, std::pair<int, int>& chunk)
+    {
+        {
+            auto& own = queues_[id];
+            std::lock_guard<std::mutex> _(own.guard);
+            if (!own.chunks.empty())
+            {
+                chunk = own.chunks.back();
+                own.chunks.pop_back();
+                return true;
+            }
+        }
+        for (std::size_t i = 1; i < queues_.size(); i++)
+        {
+            auto& victim = queues_[(id + i) % queues_.size()];
+            std::lock_guard<std::mutex> _(victim.guard);
+            if (!victim.chunks.empty())
+            {
+                chunk = victim.chunks.front();
+                victim.chunks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void workerLoop_(unsigned int id)
+    {
+        std::size_t seenJob = 0;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(jobGuard_);
+                jobReady_.wait(lock, [&]() { return stop_ || jobId_ != seenJob; });
+                if (stop_)
+                    return;
+                seenJob = jobId_;
+            }
+            std::pair<int, int> chunk;
+            while (popOrSteal_(id, chunk))
+            {
+                chunkFunc_(chunk.first, chunk.second);
+                if (remainingChunks_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                {
+                    std::lock_guard<std::mutex> _(jobGuard_);
+                    jobDone_.notify_all();
+                }
+            }
+        }
+    }
+
+    std::vector<WorkQueue> queues_;
+    std::vector<std::thread> workers_;
+    std::function<void(int, int)> chunkFunc_;
+    std::atomic<int> remainingChunks_{ 0 };
+    std::mutex submitGuard_;
+    std::mutex jobGuard_;
+    std::condition_variable jobReady_, jobDone_;
+    std::size_t jobId_ = 0;
+    bool stop_ = false;
+};
+
+// Shared by all callers of parallel_for; kept out of the template so that every Func uses it.
+inline ThreadPool& DefaultPool()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+template<typename Func>
+void parallel_for(Range range, int grain, Func&& f, ProgressBar& bar)
+{
+    DefaultPool().parallel_for(range, grain, std::forward<Func>(f), bar);
+    return;
+}
+
 // For test purpose.
 ProgressBar bar(100);
 // generate random work time.
@@ -168,3 +340,100 @@ int main()
     }
     return 0;
 }
+
+// main2.cpp, parallel_for against the thread-per-task pattern above.
+// Run with stderr redirected(e.g. 2>/dev/null) so that drawing the bar doesn't dominate.
+inline auto GetIntervalSecond(std::chrono::steady_clock::time_point& t1,
+    std::chrono::steady_clock::time_point& t2)
+{
+    return std::chrono::duration_cast<std::chrono::duration<double>>(t2 - t1);
+}
+
+constexpr int jobTimes = 20;
+constexpr int threadNum = 10;
+std::vector<double> result;
+
+// grain == 1 is the pattern of main1, updating the bar per item.
+template<typename Func>
+void ManualThreads(int itemNum, int grain, Func&& f, ProgressBar& bar)
+{
+    std::thread threads[threadNum];
+    int sliceSize = (itemNum - 1) / threadNum + 1;
+    for (int i = 0; i < threadNum; i++)
+    {
+        threads[i] = std::thread{ [&, i]() {
+            int sliceEnd = std::min((i + 1) * sliceSize, itemNum);
+            for (int begin = i * sliceSize; begin < sliceEnd; begin += grain)
+            {
+                int end = begin + std::min(grain, sliceEnd - begin);
+                for (int j = begin; j < end; j++)
+                {
+                    f(j);
+                }
+                bar.update(end - begin);
+            }
+        } };
+    }
+    for (int i = 0; i < threadNum; i++)
+    {
+        threads[i].join();
+    }
+    return;
+}
+
+// All three use threadNum threads, so that per-chunk reporting and thread reuse are measured apart.
+template<typename Func>
+void Bench(const char* name, int itemNum, int grain, Func&& f, ThreadPool& pool)
+{
+    ProgressBar bar(itemNum);
+    auto beginTime = std::chrono::steady_clock::now(), endTime = beginTime;
+    for (int _ = 0; _ < jobTimes; _++)
+    {
+        bar.reset(itemNum);
+        ManualThreads(itemNum, 1, f, bar);
+    }
+    endTime = std::chrono::steady_clock::now();
+    std::cout << std::format("{} thread-per-task, per-item update : {}\n", name, GetIntervalSecond(beginTime, endTime));
+
+    beginTime = std::chrono::steady_clock::now();
+    for (int _ = 0; _ < jobTimes; _++)
+    {
+        bar.reset(itemNum);
+        ManualThreads(itemNum, grain, f, bar);
+    }
+    endTime = std::chrono::steady_clock::now();
+    std::cout << std::format("{} thread-per-task, per-chunk update : {}\n", name, GetIntervalSecond(beginTime, endTime));
+
+    beginTime = std::chrono::steady_clock::now();
+    for (int _ = 0; _ < jobTimes; _++)
+    {
+        bar.reset(itemNum);
+        pool.parallel_for({ 0, itemNum }, grain, f, bar);
+    }
+    endTime = std::chrono::steady_clock::now();
+    std::cout << std::format("{} parallel_for : {}\n", name, GetIntervalSecond(beginTime, endTime));
+    return;
+}
+
+int main()
+{
+    ThreadPool pool(threadNum);
+    // Fine-grained : a few flops per item.
+    constexpr int fineNum = 1 << 20;
+    result.resize(fineNum);
+    Bench("Fine-grained", fineNum, 4096, [](int i) {
+        result[i] = std::sqrt(static_cast<double>(i)) * 0.5 + 1.0;
+    }, pool);
+
+    // Coarse-grained : about tens of microseconds per item.
+    constexpr int coarseNum = 1000;
+    Bench("Coarse-grained", coarseNum, 8, [](int i) {
+        double sum = 0.0;
+        for (int j = 0; j < 20000; j++)
+        {
+            sum += std::sqrt(static_cast<double>(i + j));
+        }
+        result[i] = sum;
+    }, pool);
+    return 0;
+}
@@ -1,9 +1,30 @@
 // Check whether key matches required type rules.
 // C++20 needed, clang & gcc compile right while msvc fails in Sep 1st, 2022(This has been reported to the MS team).
-// In the future, this may evolve to Pythonic key-value function wrapper, which needs 
-// mapping from string to varaibles that may be supported by C++23 reflection.
+// CallWithKeywords is the Pythonic key-value function wrapper: keyword arguments Kw<"key">(value)
+// are reordered at compile time into positional ones, see PythonicDisasmCheck.py for its generated code.
+// Mapping from string to varaibles of the callee itself still waits for C++23 reflection.
+// BindKeywords does the same at runtime, parsing key-value text into typed parameters.
+// main2.cpp binds 100000 configs of 8 keys, GCC 12.2 -O2 output :
+/* std::map parser : 0.197487s, 890000 allocations
+   BindKeywords : 0.0999955s, 0 allocations
+   Bind in right.
+*/
+// Key lookup is a constexpr perfect hash, see PythonicCompileBench.py for compile cost.
+// GCC 12.2 -fsyntax-only, linear lookup before vs perfect hash now.
+// The linear version took Args... by value in FuncCheck, which rejects the variables used by the
+// script; it was measured with both FuncCheck overloads changed to Args&&... as they are now.
+/* 10 keys : 0.124s, 34.1MB vs 0.147s, 34.7MB
+   100 keys : 0.471s, 68.3MB vs 0.132s, 39.6MB
+   300 keys : 3.146s, 340.3MB vs 0.258s, 55.0MB
+   1000 keys : failed(constexpr depth > 512) after 30.487s, 3674.0MB vs 1.025s, 111.4MB
+*/
 
 #include <array>
+#include <charconv>
+#include <cstdint>
+#include <string_view>
+#include <tuple>
+#include <utility>
 #include <type_traits>
 
 constexpr bool CompareStr(const char* str1, const char* str2)
@@ -11,6 +32,27 @@ constexpr bool CompareStr(const char* str1, const char* str2)
     return *str1 == *str2 && (*str1 == '\0' || CompareStr(str1 + 1, str2 + 1));
 }    
 
+// FNV-1a with a seeded offset basis, so that strings colliding under one seed are separated
+// by others. Its low bits are poorly mixed, so MixHash is applied before taking a slot.
+constexpr std::uint32_t HashStr(std::string_view str, std::uint32_t seed)
+{
+    std::uint32_t hash = 2166136261u ^ (seed * 0x9E3779B9u);
+    for (char ch : str)
+        hash = (hash ^ static_cast<unsigned char>(ch)) * 16777619u;
+    return hash;
+}
+
+// murmur3 finalizer.
+constexpr std::uint32_t MixHash(std::uint32_t hash)
+{
+    hash ^= hash >> 16;
+    hash *= 0x85EBCA6Bu;
+    hash ^= hash >> 13;
+    hash *= 0xC2B2AE35u;
+    hash ^= hash >> 16;
+    return hash;
+}
+
 template<template<typename> typename ...Ts>
 class Checker
 {
@@ -21,48 +63,112 @@ public:
         template<typename T>
         static constexpr bool CheckType(int id)
         {
-            if (id >= sizeof...(Ts) || id < 0)
-                return false;
-            return CheckType_<T, Ts...>(id);
+            int i = 0;
+            return ((i++ == id && Ts<T>::value) || ...);
         }
-    private:
-        // just to escape compliation error.
-        template<typename T>
-        static constexpr bool CheckType_(int id)
+    };
+
+    // Perfect hash by hash-and-displace: keys are grouped into buckets by HashStr, then
+    // buckets are placed from the largest one, each searching a displacement that sends 
+    // all its keys to free slots. Duplicated keys, or a bucket that can't be placed within
+    // maxSeedNum_ displacements, make the construction not a constant expression.
+    constexpr Checker(const std::array<const char*, sizeof...(Ts)>& init_keyList) :
+        keyList(init_keyList)
+    {
+        std::array<std::uint32_t, keyNum_> hashes{};
+        std::array<int, bucketNum_ + 1> bucketStart{};
+        std::array<int, keyNum_> keysByBucket{};
+        for (std::size_t i = 0; i < keyNum_; i++)
         {
-            return false;
+            hashes[i] = HashStr(keyList[i], 0);
+            bucketStart[hashes[i] % bucketNum_ + 1]++;
+        }
+        int maxBucketSize = 0;
+        for (std::size_t i = 0; i < bucketNum_; i++)
+        {
+            maxBucketSize = bucketStart[i + 1] > maxBucketSize ? bucketStart[i + 1] : maxBucketSize;
+            bucketStart[i + 1] += bucketStart[i];
+        }
+        std::array<int, bucketNum_> bucketFill{};
+        for (std::size_t i = 0; i < keyNum_; i++)
+        {
+            std::size_t bucket = hashes[i] % bucketNum_;
+            keysByBucket[bucketStart[bucket] + bucketFill[bucket]++] = static_cast<int>(i);
         }
 
-        template<typename T, template<typename> typename U, template<typename> typename ...Us>
-        static constexpr bool CheckType_(int id)
+        slots.fill(-1);
+        for (int size = maxBucketSize; size > 0; size--)
         {
-            if (id == 0)
-                return U<T>::value;
-            return CheckType_<T, Us...>(id - 1);
+            for (std::size_t bucket = 0; bucket < bucketNum_; bucket++)
+            {
+                if (bucketStart[bucket + 1] - bucketStart[bucket] != size)
+                    continue;
+                const int* keys = keysByBucket.data() + bucketStart[bucket];
+                for (int i = 0; i < size; i++)
+                {
+                    for (int j = 0; j < i; j++)
+                    {
+                        if (CompareStr(keyList[keys[i]], keyList[keys[j]]))
+                            throw "Duplicated key in the key list.";
+                    }
+                }
+                for (std::uint32_t seed = 0; ; seed++)
+                {
+                    if (seed == maxSeedNum_)
+                        throw "Failed to build the perfect hash of the key list.";
+                    std::array<std::size_t, keyNum_> taken{};
+                    bool success = true;
+                    for (int i = 0; i < size && success; i++)
+                    {
+                        std::uint32_t hash = seed == 0 ? hashes[keys[i]] : HashStr(keyList[keys[i]], seed);
+                        taken[i] = MixHash(hash) % slotNum_;
+                        success = slots[taken[i]] == -1;
+                        for (int j = 0; j < i && success; j++)
+                            success = taken[i] != taken[j];
+                    }
+                    if (!success)
+                        continue;
+                    for (int i = 0; i < size; i++)
+                        slots[taken[i]] = keys[i];
+                    displacement[bucket] = seed;
+                    break;
+                }
+            }
         }
-    };
+    }
+
+    // Return index of the key, or -1 if not in the key list.
+    // Also used at runtime by BindKeywords, where the table has been built in compile time.
+    constexpr int Find(std::string_view key) const
+    {
+        std::uint32_t hash = HashStr(key, 0), seed = displacement[hash % bucketNum_];
+        int id = slots[MixHash(seed == 0 ? hash : HashStr(key, seed)) % slotNum_];
+        return id >= 0 && key == keyList[id] ? id : -1;
+    }
 
-    constexpr Checker(const std::array<const char*, sizeof...(Ts)>& init_keyList) :
-        keyList(init_keyList){};
     std::array<const char*, sizeof...(Ts)> keyList;
     TypeChecker typeChecker;
+
+private:
+    static constexpr std::size_t keyNum_ = sizeof...(Ts);
+    static constexpr std::size_t bucketNum_ = keyNum_ > 0 ? keyNum_ : 1;
+    static constexpr std::size_t slotNum_ = 2 * bucketNum_;
+    static constexpr std::uint32_t maxSeedNum_ = 1u << 16;
+    std::array<std::uint32_t, bucketNum_> displacement{};
+    std::array<int, slotNum_> slots{};
 };
 
 template<typename T, template<typename> typename ...Ts>
 constexpr int inArr(const char* para, const Checker<Ts...>& checker)
 {
-    for (std::size_t i = 0; i < checker.keyList.size(); i++)
-    {
-        if (CompareStr(para, checker.keyList[i]))
-        {
-            return checker.typeChecker.template CheckType<T>(i) ? i : -2;
-        }
-    }
-    return -1;
+    int id = checker.Find(para);
+    if (id == -1)
+        return -1;
+    return checker.typeChecker.template CheckType<T>(id) ? id : -2;
 }
 
 template<typename ...Args>
-constexpr int FuncCheck(const int id, Args... args)
+constexpr int FuncCheck(const int id, Args&&... args)
 {
     if (sizeof...(args) == 1)
         return -1;
@@ -70,11 +176,12 @@ constexpr int FuncCheck(const int id, Args... args)
 }
 
 template<typename T, template<typename> typename ...Ts, typename ...Args>
-constexpr int FuncCheck(const int id, const Checker<Ts...>& checker, const char* arg1, T&&, Args... args)
+constexpr int FuncCheck(const int id, const Checker<Ts...>& checker, const char* arg1, T&&, Args&&... args)
 {
-    if (inArr<std::remove_cvref_t<T>>(arg1, checker) == -1)
+    int result = inArr<std::remove_cvref_t<T>>(arg1, checker);
+    if (result == -1)
         return id;
-    else if (inArr<std::remove_cvref_t<T>>(arg1, checker) == -2)
+    else if (result == -2)
         return id + 1;
     return FuncCheck(id + 2, checker, args...);
 }
@@ -89,14 +196,321 @@ constexpr int FuncCheck(const int id, const Checker<Ts...>& checker, const char*
     }(); \
     func(__VA_ARGS__);
 
+// String usable as a template argument, so that keywords are known in compile time.
+template<std::size_t N>
+struct FixedStr
+{
+    constexpr FixedStr(const char (&init_str)[N])
+    {
+        for (std::size_t i = 0; i < N; i++)
+            str[i] = init_str[i];
+    }
+    char str[N];
+};
+
+// Keyword argument made by Kw<"key">(value). The key is in the type, so checking it never
+// evaluates value, which can be any expression; only a reference to value is kept.
+template<FixedStr key, typename T>
+struct Keyword
+{
+    using ValueType = std::remove_cvref_t<T>;
+    static constexpr const char* name = key.str;
+    constexpr T&& Forward() const { return static_cast<T&&>(value); }
+    T&& value;
+};
+
+template<FixedStr key, typename T>
+constexpr Keyword<key, T> Kw(T&& value)
+{
+    return { std::forward<T>(value) };
+}
+
+template<std::size_t I, typename Keywords>
+using KeywordAt = std::remove_cvref_t<std::tuple_element_t<I, Keywords>>;
+
+// Return -1 if all keywords are in the key list with right types, otherwise index of the first wrong one.
+template<typename Keywords, template<typename> typename ...Ts, std::size_t ...Is>
+constexpr int KeywordCheck(const Checker<Ts...>& checker, std::index_sequence<Is...>)
+{
+    std::array<int, sizeof...(Is)> results{
+        inArr<typename KeywordAt<Is, Keywords>::ValueType>(KeywordAt<Is, Keywords>::name, checker)... };
+    for (std::size_t i = 0; i < results.size(); i++)
+    {
+        if (results[i] < 0)
+            return static_cast<int>(i);
+    }
+    return -1;
+}
+
+template<typename Defaults, template<typename> typename ...Ts>
+constexpr bool DefaultsCheck(const Checker<Ts...>&)
+{
+    using DefaultsType = std::remove_cvref_t<Defaults>;
+    if constexpr (std::tuple_size_v<DefaultsType> != sizeof...(Ts))
+        return false;
+    else
+        return []<std::size_t ...Is>(std::index_sequence<Is...>) {
+            return (Checker<Ts...>::TypeChecker::template CheckType<
+                std::remove_cvref_t<std::tuple_element_t<Is, DefaultsType>>>(Is) && ...);
+        }(std::make_index_sequence<sizeof...(Ts)>{});
+}
+
+// order[id] is the position of keyword of key id, or -1 if it's missing.
+template<typename Keywords, template<typename> typename ...Ts, std::size_t ...Is>
+constexpr std::array<int, sizeof...(Ts)> KeywordOrder(const Checker<Ts...>& checker, std::index_sequence<Is...>)
+{
+    std::array<int, sizeof...(Ts)> order{};
+    order.fill(-1);
+    std::array<const char*, sizeof...(Is)> keys{ KeywordAt<Is, Keywords>::name... };
+    for (std::size_t i = 0; i < keys.size(); i++)
+    {
+        int id = checker.Find(keys[i]);
+        // Unknown keys have been reported by KeywordCheck.
+        if (id < 0)
+            continue;
+        if (order[id] != -1)
+            throw "Duplicated keyword argument.";
+        order[id] = static_cast<int>(i);
+    }
+    return order;
+}
+
+template<int pos, typename Default, typename Args>
+constexpr decltype(auto) SelectArg(Default& defaultValue, Args& args)
+{
+    if constexpr (pos < 0)
+        return (defaultValue);
+    else
+        return std::get<pos>(args).Forward();
+}
+
+template<auto order, typename Func, typename Defaults, typename Args, std::size_t ...Is>
+constexpr decltype(auto) CallPositional(Func&& func, Defaults&& defaults, Args&& args, std::index_sequence<Is...>)
+{
+    return std::forward<Func>(func)(SelectArg<order[Is]>(std::get<Is>(defaults), args)...);
+}
+
+// e.g. CallWithKeywords(func, checker, std::tuple{ 1, 1.0f }, Kw<"height">(2.0f)) is func(1, 2.0f).
+// Keys never reach func, so the call compiles to the same code as the positional one.
+#define CallWithKeywords(func, checker, defaults, ...) \
+    [&]()->decltype(auto)\
+    {\
+        using __Keywords = decltype(std::forward_as_tuple(__VA_ARGS__)); \
+        constexpr auto __seq = std::make_index_sequence<std::tuple_size_v<__Keywords>>{}; \
+        constexpr int __r = KeywordCheck<__Keywords>(checker, __seq); \
+        static_assert(__r == -1, "Some keywords are not in the key list, or the corresponding value has a wrong type."\
+            "\nCheck the result value to get which one is wrong."); \
+        static_assert(DefaultsCheck<decltype(defaults)>(checker), \
+            "There should be one default value for each key, with the type required by the key."); \
+        constexpr auto __order = KeywordOrder<__Keywords>(checker, __seq); \
+        return CallPositional<__order>([&](auto&&... __args)->decltype(auto) {\
+                return func(std::forward<decltype(__args)>(__args)...); \
+            }, defaults, std::forward_as_tuple(__VA_ARGS__), std::make_index_sequence<__order.size()>{}); \
+    }()
+
+template<typename T>
+bool ParseValue(std::string_view str, T& value)
+{
+    if constexpr (std::is_same_v<T, bool>)
+    {
+        if (str != "true" && str != "false")
+            return false;
+        value = (str == "true");
+        return true;
+    }
+    else
+    {
+        static_assert(std::is_arithmetic_v<T>, "Only arithmetic parameters can be parsed.");
+        // Parse into a copy so that value is untouched by a wrong entry.
+        T result{};
+        auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), result);
+        if (ec != std::errc{} || ptr != str.data() + str.size())
+            return false;
+        value = result;
+        return true;
+    }
+}
+
+constexpr std::string_view TrimStr(std::string_view str)
+{
+    constexpr std::string_view blanks = " \t\r";
+    std::size_t begin = str.find_first_not_of(blanks);
+    if (begin == std::string_view::npos)
+        return {};
+    return str.substr(begin, str.find_last_not_of(blanks) - begin + 1);
+}
+
+// Parse "key = value" entries separated by ',', ';' or new lines into params, whose element i
+// is the value of key i, e.g. std::tie(config.width, config.height); missing keys are untouched.
+// Key is dispatched by the perfect hash of checker, and types of params are checked against
+// its rules in compile time. Nothing is allocated.
+// Return -1 if all entries are bound, otherwise the offset of the first wrong entry in text.
+template<template<typename> typename ...Ts, typename Params>
+int BindKeywords(const Checker<Ts...>& checker, std::string_view text, Params&& params)
+{
+    using ParamsType = std::remove_cvref_t<Params>;
+    static_assert(std::tuple_size_v<ParamsType> == sizeof...(Ts), "There should be one parameter for each key.");
+    static_assert([]<std::size_t ...Is>(std::index_sequence<Is...>) {
+        return (Checker<Ts...>::TypeChecker::template CheckType<
+            std::remove_cvref_t<std::tuple_element_t<Is, ParamsType>>>(Is) && ...);
+    }(std::make_index_sequence<sizeof...(Ts)>{}), "Some parameters have a wrong type.");
+
+    std::size_t begin = 0;
+    while (begin < text.size())
+    {
+        std::size_t end = text.find_first_of(",;\n", begin);
+        if (end == std::string_view::npos)
+            end = text.size();
+        std::string_view entry = text.substr(begin, end - begin);
+        if (!TrimStr(entry).empty())
+        {
+            std::size_t equal = entry.find('=');
+            if (equal == std::string_view::npos)
+                return static_cast<int>(begin);
+            int id = checker.Find(TrimStr(entry.substr(0, equal)));
+            std::string_view value = TrimStr(entry.substr(equal + 1));
+            bool success = [&]<std::size_t ...Is>(std::index_sequence<Is...>) {
+                return ((id == static_cast<int>(Is) && ParseValue(value, std::get<Is>(params))) || ...);
+            }(std::make_index_sequence<sizeof...(Ts)>{});
+            if (!success)
+                return static_cast<int>(begin);
+        }
+        begin = end + 1;
+    }
+    return -1;
+}
+
 template<typename ...Ts>
 void func(Ts...) {};
 
+float Area(int width, float height) { return width * height; }
+
 int main()
 {
     constexpr Checker<std::is_integral, std::is_floating_point> checker{ {"width", "height"} };
     int b = 2;
     // Wait for reflection.
     CallWithChecker(func, checker, "width", b, "height", 1.0f);
+    // Same as Area(1, 3.0f).
+    float area = CallWithKeywords(Area, checker, std::tuple(1, 1.0f), Kw<"height">(3.0f));
+    return area == 3.0f ? 0 : 1;
+}
+
+// main2.cpp, BindKeywords against a naive std::map parser on a batch of configs.
+#include <chrono>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <map>
+#include <new>
+#include <string>
+#include <vector>
+
+inline auto GetIntervalSecond(std::chrono::steady_clock::time_point& t1,
+    std::chrono::steady_clock::time_point& t2)
+{
+    return std::chrono::duration_cast<std::chrono::duration<double>>(t2 - t1);
+}
+
+std::size_t allocationCnt = 0;
+
+void* operator new(std::size_t size)
+{
+    allocationCnt++;
+    if (void* ptr = std::malloc(size))
+        return ptr;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+template<typename T>
+using IsBool = std::is_same<T, bool>;
+
+struct JobConfig
+{
+    int width = 1, height = 1, depth = 1, seed = 0;
+    float scale = 1.0f, gamma = 2.2f;
+    double exposure = 0.0;
+    bool verbose = false;
+
+    auto Tie() { return std::tie(width, height, depth, seed, scale, gamma, exposure, verbose); }
+};
+
+constexpr Checker<std::is_integral, std::is_integral, std::is_integral, std::is_integral,
+    std::is_floating_point, std::is_floating_point, std::is_floating_point, IsBool> jobChecker{
+    { "width", "height", "depth", "seed", "scale", "gamma", "exposure", "verbose" } };
+
+bool NaiveBind(const std::string& text, JobConfig& config)
+{
+    std::map<std::string, std::string> entries;
+    std::size_t begin = 0;
+    while (begin < text.size())
+    {
+        std::size_t end = std::min(text.find_first_of(",;\n", begin), text.size());
+        std::string entry = text.substr(begin, end - begin);
+        std::size_t equal = entry.find('=');
+        if (equal != std::string::npos)
+            entries[std::string{ TrimStr(std::string_view{ entry }.substr(0, equal)) }] =
+                std::string{ TrimStr(std::string_view{ entry }.substr(equal + 1)) };
+        begin = end + 1;
+    }
+    for (auto& [key, value] : entries)
+    {
+        if (key == "width") config.width = std::stoi(value);
+        else if (key == "height") config.height = std::stoi(value);
+        else if (key == "depth") config.depth = std::stoi(value);
+        else if (key == "seed") config.seed = std::stoi(value);
+        else if (key == "scale") config.scale = std::stof(value);
+        else if (key == "gamma") config.gamma = std::stof(value);
+        else if (key == "exposure") config.exposure = std::stod(value);
+        else if (key == "verbose") config.verbose = (value == "true");
+        else return false;
+    }
+    return true;
+}
+
+int main()
+{
+    constexpr int jobNum = 100000;
+    std::vector<std::string> configs;
+    for (int i = 0; i < jobNum; i++)
+    {
+        configs.push_back(std::format("width = {}, height = {}, depth = {}\nseed = {}; scale = {}\n"
+            "exposure = {}, gamma = 2.4, verbose = {}\n", 64 + i % 512, 32 + i % 256, 1 + i % 16, i,
+            0.5 + i % 7, -1.25 * (i % 5), i % 2 ? "true" : "false"));
+    }
+
+    std::vector<JobConfig> naiveResults(jobNum), bindResults(jobNum);
+    std::size_t allocationBegin = allocationCnt;
+    auto beginTime = std::chrono::steady_clock::now(), endTime = beginTime;
+    for (int i = 0; i < jobNum; i++)
+    {
+        NaiveBind(configs[i], naiveResults[i]);
+    }
+    endTime = std::chrono::steady_clock::now();
+    std::cout << std::format("std::map parser : {}, {} allocations\n",
+        GetIntervalSecond(beginTime, endTime), allocationCnt - allocationBegin);
+
+    allocationBegin = allocationCnt;
+    beginTime = std::chrono::steady_clock::now();
+    for (int i = 0; i < jobNum; i++)
+    {
+        BindKeywords(jobChecker, configs[i], bindResults[i].Tie());
+    }
+    endTime = std::chrono::steady_clock::now();
+    std::cout << std::format("BindKeywords : {}, {} allocations\n",
+        GetIntervalSecond(beginTime, endTime), allocationCnt - allocationBegin);
+
+    for (int i = 0; i < jobNum; i++)
+    {
+        if (naiveResults[i].Tie() != bindResults[i].Tie())
+        {
+            std::cout << std::format("Oops, wrong in job {}\n", i);
+            return 1;
+        }
+    }
+    std::cout << "Bind in right.\n";
     return 0;
 }
@@ -0,0 +1,65 @@
+# Build-time benchmark of Checker in Pythonic.cpp.
+# Generates checkers with 10 ~ 1000 keys, checks every key once by CallWithChecker
+# (8 pairs per call), and reports compile time and peak memory of the compiler.
+# Usage : python3 PythonicCompileBench.py [source=Pythonic.cpp] [compiler=g++]
+
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+keyNums = [10, 30, 100, 300, 1000]
+pairsPerCall = 8
+
+
+def Generate(source, keyNum):
+    # Drop the demo main of the source and append the generated one.
+    code = source[:source.index("int main()")]
+    traits = ", ".join("std::is_integral" if i % 2 == 0 else "std::is_floating_point"
+                       for i in range(keyNum))
+    keys = ", ".join(f'"key_{i}"' for i in range(keyNum))
+    code += f"constexpr Checker<{traits}> checker{{ {{ {keys} }} }};\n\n"
+    code += "int main()\n{\n    int b = 2;\n    float f = 1.0f;\n"
+    for begin in range(0, keyNum, pairsPerCall):
+        pairs = ", ".join(f'"key_{i}", {"b" if i % 2 == 0 else "f"}'
+                          for i in range(begin, min(begin + pairsPerCall, keyNum)))
+        code += f"    CallWithChecker(func, checker, {pairs});\n"
+    code += "    return 0;\n}\n"
+    return code
+
+
+def Compile(compiler, path):
+    beginTime = time.perf_counter()
+    process = subprocess.Popen([compiler, "-std=c++20", "-fsyntax-only", path],
+                               stdout=subprocess.DEVNULL, stderr=subprocess.PIPE)
+    stderr = process.stderr.read()
+    # wait4 gives rusage of this compilation only, including cc1plus.
+    _, status, usage = os.wait4(process.pid, 0)
+    endTime = time.perf_counter()
+    return os.waitstatus_to_exitcode(status) == 0, endTime - beginTime, usage.ru_maxrss, stderr
+
+
+def main():
+    sourcePath = sys.argv[1] if len(sys.argv) > 1 else \
+        os.path.join(os.path.dirname(os.path.abspath(__file__)), "Pythonic.cpp")
+    compiler = sys.argv[2] if len(sys.argv) > 2 else "g++"
+    with open(sourcePath, newline="") as file:
+        source = file.read()
+
+    with tempfile.TemporaryDirectory() as directory:
+        for keyNum in keyNums:
+            path = os.path.join(directory, f"checker{keyNum}.cpp")
+            with open(path, "w") as file:
+                file.write(Generate(source, keyNum))
+            success, second, memory, stderr = Compile(compiler, path)
+            if success:
+                print(f"{keyNum} keys : {second:.3f}s, {memory / 1024:.1f}MB")
+            else:
+                firstError = next((line for line in stderr.decode().splitlines()
+                                   if "error" in line), "unknown error")
+                print(f"{keyNum} keys : failed after {second:.3f}s, {memory / 1024:.1f}MB ({firstError.strip()})")
+
+
+if __name__ == "__main__":
+    main()
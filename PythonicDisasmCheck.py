@@ -0,0 +1,92 @@
+# Disassembly check of CallWithKeywords in Pythonic.cpp.
+# Compiles keyword calls and the hand-written positional calls side by side, and
+# checks that their assembly is the same at each optimization level.
+# Usage : python3 PythonicDisasmCheck.py [source=Pythonic.cpp] [compiler=g++]
+
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+optLevels = ["-O1", "-O2", "-O3"]
+
+# Callees are only declared so that calls can't be inlined away.
+cases = """
+extern "C" float Area(int width, float height, long depth);
+extern "C" void Fill(const std::string& name, int width, float height, long depth);
+extern "C" int Width();
+
+constexpr Checker<std::is_integral, std::is_floating_point, std::is_integral> checker{ {"width", "height", "depth"} };
+constexpr std::tuple defaults{ 1, 1.0f, 1L };
+
+extern "C" float ReorderedByKeyword(int b, float h, long d) { return CallWithKeywords(Area, checker, defaults, Kw<"depth">(d), Kw<"height">(h), Kw<"width">(b)); }
+extern "C" float ReorderedByPosition(int b, float h, long d) { return Area(b, h, d); }
+
+extern "C" float DefaultedByKeyword(float h) { return CallWithKeywords(Area, checker, defaults, Kw<"height">(h)); }
+extern "C" float DefaultedByPosition(float h) { return Area(1, h, 1L); }
+
+extern "C" float AllDefaultByKeyword() { return CallWithKeywords(Area, checker, defaults); }
+extern "C" float AllDefaultByPosition() { return Area(1, 1.0f, 1L); }
+
+extern "C" float LiteralByKeyword() { return CallWithKeywords(Area, checker, defaults, Kw<"width">(3), Kw<"depth">(5L)); }
+extern "C" float LiteralByPosition() { return Area(3, 1.0f, 5L); }
+
+// Values are evaluated in keyword order, like arguments of any call, so that order is kept here.
+extern "C" float ExpressionByKeyword(float h, long d) { return CallWithKeywords(Area, checker, defaults, Kw<"width">(Width() + 1), Kw<"height">(h * 2.0f), Kw<"depth">(d << 2)); }
+extern "C" float ExpressionByPosition(float h, long d) { return Area(Width() + 1, h * 2.0f, d << 2); }
+
+extern "C" void CapturedByKeyword(const std::string& name, int b) { CallWithKeywords([&](int w, float h, long d) { Fill(name, w, h, d); }, checker, defaults, Kw<"width">(b)); }
+extern "C" void CapturedByPosition(const std::string& name, int b) { Fill(name, b, 1.0f, 1L); }
+"""
+
+
+def Generate(source):
+    return "#include <string>\n" + source[:source.index("int main()")] + cases
+
+
+def FunctionBodies(assembly):
+    bodies, name = {}, None
+    for line in assembly.splitlines():
+        label = re.match(r"^(\w+):", line)
+        if label and not label.group(1).startswith("."):
+            name = label.group(1)
+            bodies[name] = []
+        elif name and ".cfi_endproc" in line:
+            name = None
+        elif name and not line.strip().startswith(".cfi"):
+            # Local labels are numbered per file, so only their presence is compared.
+            bodies[name].append(re.sub(r"\.L\w+", ".L", line.strip()))
+    return bodies
+
+
+def main():
+    sourcePath = sys.argv[1] if len(sys.argv) > 1 else \
+        os.path.join(os.path.dirname(os.path.abspath(__file__)), "Pythonic.cpp")
+    compiler = sys.argv[2] if len(sys.argv) > 2 else "g++"
+    with open(sourcePath, newline="") as file:
+        source = file.read()
+
+    allSame = True
+    with tempfile.TemporaryDirectory() as directory:
+        path = os.path.join(directory, "keywords.cpp")
+        with open(path, "w") as file:
+            file.write(Generate(source))
+        for optLevel in optLevels:
+            assembly = subprocess.run([compiler, "-std=c++20", optLevel, "-S", "-o", "-", path],
+                                      check=True, capture_output=True, text=True).stdout
+            bodies = FunctionBodies(assembly)
+            for name in bodies:
+                if not name.endswith("ByKeyword"):
+                    continue
+                positional = name.replace("ByKeyword", "ByPosition")
+                same = bodies[name] == bodies[positional]
+                allSame = allSame and same
+                print(f"{optLevel} {name} : {'same' if same else 'DIFFERENT'}")
+                if not same:
+                    print("\n".join(bodies[name]), "\n---\n", "\n".join(bodies[positional]))
+    return 0 if allSame else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())